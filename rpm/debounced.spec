@@ -9,10 +9,9 @@ Source0:        %{name}-%{version}.tar.gz
 
 BuildRequires:  gcc
 BuildRequires:  make
-BuildRequires:  libevdev-devel
 BuildRequires:  pkgconfig
+BuildRequires:  systemtap-sdt-devel
 
-Requires:       libevdev
 Requires:       systemd
 
 %global debug_package %{nil}
@@ -45,6 +44,7 @@ Simple daemon to debounce keyboard input and provide FlashTap features.
 %{_unitdir}/debounced.service
 %{_mandir}/man8/debounced.8*
 %{_mandir}/man8/debouncectl.8*
+%{_datadir}/debounced/
 
 %changelog
 * Tue Mar 17 2026 Vincent Meadows <giantvince1@protonmail.com> - 2.0-1
@@ -0,0 +1,282 @@
+// HID-BPF debounce backend: the same asymmetric debounce and FlashTap logic as
+// process_debounce()/handle_flashtap() in debounced.c, run inside the kernel on the
+// raw HID reports of a boot-protocol keyboard (8 bytes: modifiers, reserved, 6 keys).
+//
+// Presses pass through immediately. A release arriving less than debounce_ns after
+// the press is hidden by keeping the usage in the report; a bpf_timer fires at the
+// deadline and a bpf_wq re-injects the report without it. A re-press before the
+// deadline cancels the pending release. For FlashTap pairs only the most recently
+// pressed key of the pair is reported while both are held.
+//
+// Hardware reports and the workqueue run concurrently, so all mutable state lives in
+// one map value guarded by a bpf_spin_lock. Nothing is called with the lock held:
+// the clock is read before taking it, timers are armed and reports injected after.
+//
+// Requires a kernel with struct_ops HID-BPF (6.11+).
+
+#include "vmlinux.h"
+#include <bpf/bpf_helpers.h>
+#include <bpf/bpf_tracing.h>
+
+#include "debounce_bpf.h"
+
+#define BOOT_REPORT_SIZE 8
+#define BOOT_KEYS 6
+#define MAX_PENDING 16
+#define MAX_REINJECT 3
+#define CLOCK_MONOTONIC 1
+
+extern __u8 *hid_bpf_get_data(struct hid_bpf_ctx *ctx, unsigned int offset, const size_t __sz) __ksym;
+extern struct hid_bpf_ctx *hid_bpf_allocate_context(unsigned int hid_id) __ksym;
+extern void hid_bpf_release_context(struct hid_bpf_ctx *ctx) __ksym;
+extern int hid_bpf_input_report(struct hid_bpf_ctx *ctx, enum hid_report_type type, __u8 *buf,
+                                const size_t buf__sz) __ksym;
+extern int bpf_wq_init(struct bpf_wq *wq, void *p__map, unsigned int flags) __ksym;
+extern int bpf_wq_start(struct bpf_wq *wq, unsigned int flags) __ksym;
+extern int bpf_wq_set_callback_impl(struct bpf_wq *wq, int (callback_fn)(void *map, int *key, void *value),
+                                    unsigned int flags, void *aux__ign) __ksym;
+
+// Per-key state is indexed by HID usage
+struct db_state {
+    struct bpf_spin_lock lock;
+    __u32 gen;         // bumped on every hardware report
+    __u32 n_pending;
+    __u64 timer_at;    // deadline the timer is armed for, 0 if idle
+    __u8 hw_report[BOOT_REPORT_SIZE];  // last hardware report
+    __u8 pending[MAX_PENDING];         // releases currently held back
+    __u8 ft_last_ad, ft_last_ar;
+    __u8 logical[256];                 // down as seen by the host
+    __u64 down_ns[256];
+    __u64 release_at[256];             // pending release deadline, 0 if none
+};
+
+struct deferred {
+    struct bpf_timer timer;
+    struct bpf_wq wq;
+};
+
+struct {
+    __uint(type, BPF_MAP_TYPE_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, struct db_state);
+} state SEC(".maps");
+
+struct {
+    __uint(type, BPF_MAP_TYPE_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, struct db_config);
+} config SEC(".maps");
+
+struct {
+    __uint(type, BPF_MAP_TYPE_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, struct deferred);
+} deferred SEC(".maps");
+
+// Everything below up to the program entry points runs under the state lock, so it
+// is forced inline and only touches memory.
+#define LOCKED static __always_inline
+
+LOCKED int report_has(const __u8 *r, __u8 usage) {
+    if (usage >= HID_USAGE_LEFTCTRL) return (r[0] >> (usage - HID_USAGE_LEFTCTRL)) & 1;
+    for (int i = 0; i < BOOT_KEYS; i++)
+        if (r[2 + i] == usage) return 1;
+    return 0;
+}
+
+LOCKED void add_usage(__u8 *r, __u8 usage) {
+    if (report_has(r, usage)) return;
+    if (usage >= HID_USAGE_LEFTCTRL) {
+        r[0] |= 1 << (usage - HID_USAGE_LEFTCTRL);
+        return;
+    }
+    for (int i = 0; i < BOOT_KEYS; i++) {
+        if (r[2 + i] == 0) {
+            r[2 + i] = usage;
+            return;
+        }
+    }
+}
+
+LOCKED void drop_usage(__u8 *r, __u8 usage) {
+    for (int i = 0; i < BOOT_KEYS; i++)
+        if (r[2 + i] == usage) r[2 + i] = 0;
+}
+
+// Hardware state plus held-back releases, with FlashTap applied
+LOCKED void build_report(__u8 *out, const struct db_state *s, const struct db_config *c) {
+    __builtin_memcpy(out, s->hw_report, BOOT_REPORT_SIZE);
+    for (__u32 i = 0; i < MAX_PENDING && i < s->n_pending; i++) add_usage(out, s->pending[i]);
+    if (c->ft_ad && report_has(out, HID_USAGE_A) && report_has(out, HID_USAGE_D))
+        drop_usage(out, s->ft_last_ad == HID_USAGE_A ? HID_USAGE_D : HID_USAGE_A);
+    if (c->ft_arrows && report_has(out, HID_USAGE_LEFT) && report_has(out, HID_USAGE_RIGHT))
+        drop_usage(out, s->ft_last_ar == HID_USAGE_LEFT ? HID_USAGE_RIGHT : HID_USAGE_LEFT);
+}
+
+// Returns the deadline the timer must be (re)armed for, or 0 if the armed one is earlier
+LOCKED __u64 want_timer(struct db_state *s, __u64 deadline, __u64 now) {
+    if (s->timer_at > now && s->timer_at <= deadline) return 0;
+    s->timer_at = deadline;
+    return deadline;
+}
+
+LOCKED void key_down(struct db_state *s, __u8 usage, __u64 now) {
+    if (!s->logical[usage]) {
+        s->logical[usage] = 1;
+        s->down_ns[usage] = now;
+    } else if (s->release_at[usage]) {
+        s->release_at[usage] = 0;  // bounce: cancel the pending release
+        for (__u32 i = 0; i < MAX_PENDING && i < s->n_pending; i++) {
+            if (s->pending[i] == usage) {
+                s->pending[i] = s->pending[(s->n_pending - 1) & (MAX_PENDING - 1)];
+                s->n_pending--;
+                break;
+            }
+        }
+    }
+    if (usage == HID_USAGE_A || usage == HID_USAGE_D) s->ft_last_ad = usage;
+    if (usage == HID_USAGE_LEFT || usage == HID_USAGE_RIGHT) s->ft_last_ar = usage;
+}
+
+// Returns the timer deadline to arm, 0 if none
+LOCKED __u64 key_up(struct db_state *s, __u8 usage, __u64 now, const struct db_config *c) {
+    if (now - s->down_ns[usage] < c->debounce_ns && s->n_pending < MAX_PENDING) {
+        s->release_at[usage] = s->down_ns[usage] + c->debounce_ns;
+        s->pending[s->n_pending & (MAX_PENDING - 1)] = usage;
+        s->n_pending++;
+        return want_timer(s, s->release_at[usage], now);
+    }
+    s->logical[usage] = 0;
+    s->release_at[usage] = 0;
+    return 0;
+}
+
+static struct db_state *get_state(void) {
+    __u32 k = 0;
+    return bpf_map_lookup_elem(&state, &k);
+}
+
+static struct db_config *cfg(void) {
+    __u32 k = 0;
+    return bpf_map_lookup_elem(&config, &k);
+}
+
+static void arm_deferred(__u64 deadline, __u64 now) {
+    __u32 k = 0;
+    struct deferred *d = bpf_map_lookup_elem(&deferred, &k);
+    if (d) bpf_timer_start(&d->timer, deadline > now ? deadline - now : 0, 0);
+}
+
+// source is 0 for reports from the device and non-zero for injected ones, including
+// our own from flush_cb, which already carry the final state
+SEC("struct_ops/hid_device_event")
+int BPF_PROG(debounce_event, struct hid_bpf_ctx *hctx, enum hid_report_type type, __u64 source) {
+    if (source || hctx->size != BOOT_REPORT_SIZE) return 0;
+    __u8 *data = hid_bpf_get_data(hctx, 0, BOOT_REPORT_SIZE);
+    struct db_config *c = cfg();
+    struct db_state *s = get_state();
+    if (!data || !c || !s) return 0;
+    if (data[2] == HID_USAGE_ROLLOVER) return 0;  // phantom state: leave it alone
+    __u64 now = bpf_ktime_get_ns(), arm = 0, t;
+    __u8 cur[BOOT_REPORT_SIZE], out[BOOT_REPORT_SIZE];
+    __builtin_memcpy(cur, data, BOOT_REPORT_SIZE);
+
+    bpf_spin_lock(&s->lock);
+    for (int i = 0; i < 8; i++) {
+        __u8 bit = 1 << i;
+        if ((cur[0] & bit) && !(s->hw_report[0] & bit)) key_down(s, HID_USAGE_LEFTCTRL + i, now);
+        if (!(cur[0] & bit) && (s->hw_report[0] & bit) && (t = key_up(s, HID_USAGE_LEFTCTRL + i, now, c)))
+            arm = t;
+    }
+    for (int i = 0; i < BOOT_KEYS; i++) {
+        if (cur[2 + i] > HID_USAGE_ROLLOVER && !report_has(s->hw_report, cur[2 + i])) key_down(s, cur[2 + i], now);
+        if (s->hw_report[2 + i] > HID_USAGE_ROLLOVER && !report_has(cur, s->hw_report[2 + i]) &&
+            (t = key_up(s, s->hw_report[2 + i], now, c)))
+            arm = t;
+    }
+    __builtin_memcpy(s->hw_report, cur, BOOT_REPORT_SIZE);
+    s->gen++;
+    build_report(out, s, c);
+    bpf_spin_unlock(&s->lock);
+
+    __builtin_memcpy(data, out, BOOT_REPORT_SIZE);
+    if (arm) arm_deferred(arm, now);
+    return 0;
+}
+
+// Drops expired releases and injects the resulting report. If a hardware report
+// slipped in while injecting, ours may have overtaken it with older state, so the
+// current state is injected again.
+static int flush_cb(void *map, int *k, void *value) {
+    struct db_config *c = cfg();
+    struct db_state *s = get_state();
+    if (!c || !s) return 0;
+    __u64 now = bpf_ktime_get_ns(), next = 0;
+    __u8 out[BOOT_REPORT_SIZE];
+    __u32 gen;
+
+    bpf_spin_lock(&s->lock);
+    __u32 i = 0;
+    for (int n = 0; n < MAX_PENDING && i < s->n_pending; n++) {
+        __u8 usage = s->pending[i & (MAX_PENDING - 1)];
+        if (s->release_at[usage] > now) {
+            if (!next || s->release_at[usage] < next) next = s->release_at[usage];
+            i++;
+            continue;
+        }
+        s->logical[usage] = 0;
+        s->release_at[usage] = 0;
+        s->pending[i & (MAX_PENDING - 1)] = s->pending[(s->n_pending - 1) & (MAX_PENDING - 1)];
+        s->n_pending--;
+    }
+    s->timer_at = next;
+    build_report(out, s, c);
+    gen = s->gen;
+    bpf_spin_unlock(&s->lock);
+
+    struct hid_bpf_ctx *ctx = hid_bpf_allocate_context(c->hid_id);
+    if (ctx) {
+        for (int n = 0; n < MAX_REINJECT; n++) {
+            hid_bpf_input_report(ctx, HID_INPUT_REPORT, out, sizeof(out));
+            int stale = 0;
+            bpf_spin_lock(&s->lock);
+            if (s->gen != gen) {
+                gen = s->gen;
+                build_report(out, s, c);
+                stale = 1;
+            }
+            bpf_spin_unlock(&s->lock);
+            if (!stale) break;
+        }
+        hid_bpf_release_context(ctx);
+    }
+    if (next) arm_deferred(next, now);
+    return 0;
+}
+
+static int timer_cb(void *map, int *k, struct deferred *d) {
+    bpf_wq_start(&d->wq, 0);
+    return 0;
+}
+
+// Run once by the loader after attach to set up the deferred release path
+SEC("syscall")
+int init_deferred(void *ctx) {
+    __u32 k = 0;
+    struct deferred *d = bpf_map_lookup_elem(&deferred, &k);
+    if (!d) return -1;
+    if (bpf_timer_init(&d->timer, &deferred, CLOCK_MONOTONIC) || bpf_timer_set_callback(&d->timer, timer_cb))
+        return -1;
+    if (bpf_wq_init(&d->wq, &deferred, 0) || bpf_wq_set_callback_impl(&d->wq, flush_cb, 0, NULL)) return -1;
+    return 0;
+}
+
+SEC(".struct_ops.link")
+struct hid_bpf_ops debounce_ops = {
+    .hid_device_event = (void *)debounce_event,
+};
+
+char _license[] SEC("license") = "GPL";
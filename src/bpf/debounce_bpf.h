@@ -0,0 +1,21 @@
+#ifndef DEBOUNCE_BPF_H
+#define DEBOUNCE_BPF_H
+
+// Shared between the HID-BPF program and its loader in hid_bpf.c
+
+// HID keyboard page usages (not evdev keycodes)
+#define HID_USAGE_ROLLOVER 0x01
+#define HID_USAGE_A 0x04
+#define HID_USAGE_D 0x07
+#define HID_USAGE_RIGHT 0x4F
+#define HID_USAGE_LEFT 0x50
+#define HID_USAGE_LEFTCTRL 0xE0
+
+struct db_config {
+    __u64 debounce_ns;
+    __u32 hid_id;
+    __u8 ft_ad;
+    __u8 ft_arrows;
+};
+
+#endif
@@ -5,15 +5,21 @@
 #include <libgen.h>
 #include <limits.h>
 #include <linux/input.h>
+#include <linux/uinput.h>
+#include <poll.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <unistd.h>
 
 #define STATUS_RUNNING 0x80
+#define STATUS_REMAP 0x40
+#define STATUS_KERNEL 0x20
 #define STATUS_DEBOUNCE 0x08
 #define STATUS_FLASHTAP 0x04
 #define STATUS_PAIR_AD 0x02
@@ -26,10 +32,11 @@ typedef struct {
     char path[PATH_MAX];
     char name[256];
     int event_num;
+    int is_mouse;
 } device_info;
 
-// ---------- Show status ----------
-static int show_status(void) {
+// ---------- Query status ----------
+static int query_status(uint8_t buf[2]) {
     int sock = socket(AF_UNIX, SOCK_STREAM, 0);
     if (sock < 0) { perror("socket"); return -1; }
     struct sockaddr_un addr = {0};
@@ -40,10 +47,16 @@ static int show_status(void) {
     setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
     if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) { perror("connect"); close(sock); return -1; }
     if (write(sock, "STATUS", 6) != 6) { perror("write"); close(sock); return -1; }
-    uint8_t buf[2] = {0};
     ssize_t r = read(sock, buf, 2);
     close(sock);
     if (r != 2) { fprintf(stderr, "Failed to read status from daemon\n"); return -1; }
+    return 0;
+}
+
+// ---------- Show status ----------
+static int show_status(void) {
+    uint8_t buf[2] = {0};
+    if (query_status(buf) < 0) return -1;
     uint8_t status_byte = buf[0];
     uint8_t timeout = buf[1];
     char running = (status_byte & STATUS_RUNNING) ? 'Y' : 'N';
@@ -64,24 +77,38 @@ static int show_status(void) {
             printf("FlashTap Pair%s: %s\n", plural, ft_str);
         }
         if (status_byte & STATUS_DEBOUNCE) printf("Timeout: %dms\n", timeout);
+        printf("Backend: %s\n", (status_byte & STATUS_KERNEL) ? "HID-BPF (kernel)" : "userspace");
     }
+    printf("Remap: %s\n", (status_byte & STATUS_REMAP) ? "loaded" : "none");
     return 0;
 }
 
 // ---------- Print usage ----------
 static void print_usage(const char *prog) {
     printf("Usage: %s stop|show|status\n", prog);
-    printf("       %s start <device> [timeout] [mode] [pair]\n\n", prog);
+    printf("       %s start <device> [timeout] [mode] [pair] [backend]\n", prog);
+    printf("       %s remap <file>|none\n", prog);
+    printf("       %s bench <workload> [count] [param] [timeout] [bounce]\n\n", prog);
     printf("Commands:\n");
     printf("    stop: stops all debounce and FlashTap activity until next start\n");
-    printf("    show: lists potential keyboard device nodes in a human-readable format\n");
+    printf("    show: lists potential keyboard and mouse device nodes in a human-readable format\n");
     printf("    status: shows current status of the daemon process\n");
-    printf("    start: starts the daemon with the arguments provided (list below)\n\n");
+    printf("    start: starts the daemon with the arguments provided (list below)\n");
+    printf("    remap: loads a key remap/layer table from file, or clears it with 'none' (daemon must be stopped)\n");
+    printf("    bench: drives the daemon with a synthetic keyboard and reports latency (daemon must be stopped)\n\n");
     printf("Arguments (only 'start' command uses arguments):\n");
-    printf("    device: path to keyboard event node to start with [REQUIRED, NO DEFAULT]\n");
+    printf("    device: path to keyboard or mouse event node to start with [REQUIRED, NO DEFAULT]\n");
     printf("    timeout: length of time in ms to debounce each input for [default: 50]\n");
     printf("    mode: b (both), d (debounce only), f (FlashTap only) [default: d]\n");
     printf("    pair: ad, arrows, both, none [default: none for d, ad for f/b]\n");
+    printf("    backend: user, bpf (in-kernel HID-BPF, falls back to user) [default: user]\n\n");
+    printf("Arguments for 'bench':\n");
+    printf("    workload: typing, chord, chatter, strafe [REQUIRED, NO DEFAULT]\n");
+    printf("    count: number of keystrokes, chords or direction changes [default: 1000]\n");
+    printf("    param: keys/s for typing, keys per chord, bounces per press for chatter,\n");
+    printf("           direction changes/s for strafe [default: 20, 6, 3, 10]\n");
+    printf("    timeout: debounce timeout passed to the daemon [default: 50]\n");
+    printf("    bounce: ms between bounce edges for chatter [default: 2]\n");
 }
 
 // ---------- Comparison for numeric sort ----------
@@ -89,7 +116,7 @@ static int cmp_event(const void *a, const void *b) {
     return ((device_info*)a)->event_num - ((device_info*)b)->event_num;
 }
 
-// ---------- Show keyboards ----------
+// ---------- Show keyboards and mice ----------
 static int show_devices(void) {
     DIR *dir = opendir("/dev/input/");
     if (!dir) return 0;
@@ -108,6 +135,7 @@ static int show_devices(void) {
     for (int i = 0; i < n_events; i++) {
         int count = 0;
         int exclude_node = 0;
+        devs[i].is_mouse = 0;
         for (int d = 0; d < 2; d++) {
             DIR *sdir = opendir(symlink_dirs[d]);
             if (!sdir) continue;
@@ -122,10 +150,11 @@ static int show_devices(void) {
                 target[len] = '\0';
                 if (strcmp(basename(target), basename(devs[i].path)) != 0)
                     continue;
-                if (strcasestr(sentry->d_name, "mouse") || strcasestr(sentry->d_name, "wmi-event")) {
+                if (strcasestr(sentry->d_name, "wmi-event")) {
                     exclude_node = 1;
                     break;
                 }
+                if (strcasestr(sentry->d_name, "mouse")) devs[i].is_mouse = 1;
                 count++;
             }
             closedir(sdir);
@@ -144,9 +173,9 @@ static int show_devices(void) {
         filtered[fcount++] = devs[i];
     }
     qsort(filtered, fcount, sizeof(device_info), cmp_event);
-    if (fcount == 0) { printf("No keyboards found.\n"); return 0; }
+    if (fcount == 0) { printf("No keyboards or mice found.\n"); return 0; }
     for (int i = 0; i < fcount; i++)
-        printf("%d: %-20s %s\n", i + 1, filtered[i].path, filtered[i].name);
+        printf("%d: %-20s %s%s\n", i + 1, filtered[i].path, filtered[i].name, filtered[i].is_mouse ? " [mouse]" : "");
     return 0;
 }
 
@@ -171,16 +200,311 @@ static int send_cmd(const char *cmd) {
             fprintf(stderr, "Daemon is already idle; stop command was ignored.\n");
         if (strncasecmp(cmd, "START", 5) == 0)
             fprintf(stderr, "Daemon is already running; start command was ignored.\n");
+        if (strncasecmp(cmd, "REMAP", 5) == 0)
+            fprintf(stderr, "Remap table was rejected; stop the daemon first and check its log for parse errors.\n");
     }
     return status_code;
 }
 
+// ---------- Bench ----------
+#define BENCH_SOURCE_NAME "debounced-bench-source"
+#define BENCH_OUTPUT_NAME "debounced-virtual-keyboard"
+
+typedef struct {
+    unsigned long long at_us;   // scheduled offset from bench start
+    unsigned long long sent_us; // CLOCK_MONOTONIC time actually written
+    int seq;
+    uint16_t code;
+    int32_t value;
+    int nexp;                   // outputs this input should produce, in order
+    uint16_t exp_code[2];
+    int32_t exp_value[2];
+} bench_event;
+
+typedef struct {
+    uint16_t code;
+    int32_t value;
+    unsigned long long time_us;
+} bench_output;
+
+static const uint16_t bench_keys[] = {KEY_Q, KEY_W, KEY_E, KEY_R, KEY_T, KEY_Y, KEY_U, KEY_I, KEY_O, KEY_P,
+                                      KEY_S, KEY_F, KEY_G, KEY_H, KEY_J, KEY_K, KEY_L, KEY_Z, KEY_X, KEY_C};
+#define N_BENCH_KEYS (int)(sizeof(bench_keys) / sizeof(bench_keys[0]))
+#define BENCH_MATCH_WINDOW (2 * N_BENCH_KEYS)  // how far output may drift from the expected order
+
+static unsigned long long mono_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static bench_event *bench_add(bench_event *evs, int *n, unsigned long long at_ms, int code, int value) {
+    bench_event *e = &evs[*n];
+    *e = (bench_event){.at_us = at_ms * 1000ULL, .seq = *n, .code = code, .value = value};
+    (*n)++;
+    return e;
+}
+
+static void bench_expect(bench_event *e, int code, int value) {
+    e->exp_code[e->nexp] = code;
+    e->exp_value[e->nexp] = value;
+    e->nexp++;
+}
+
+static int cmp_bench_event(const void *a, const void *b) {
+    const bench_event *x = a, *y = b;
+    if (x->at_us != y->at_us) return x->at_us < y->at_us ? -1 : 1;
+    return x->seq - y->seq;
+}
+
+static int cmp_ull(const void *a, const void *b) {
+    unsigned long long x = *(const unsigned long long *)a, y = *(const unsigned long long *)b;
+    return (x > y) - (x < y);
+}
+
+// Builds the injection schedule; every release lands at least timeout+10ms after its press so
+// the expected output is the clean logical sequence with no debounce-delayed releases
+static int bench_schedule(bench_event *evs, const char *workload, int count, int param, int timeout, int bounce) {
+    int n = 0;
+    unsigned long long hold = timeout + 10, t = 0;
+    if (strcmp(workload, "typing") == 0) {  // param: keys per second, overlapping like real typing
+        unsigned long long period = 1000 / (param > 0 ? param : 1);
+        if (period * N_BENCH_KEYS <= hold) period = hold / N_BENCH_KEYS + 1;  // never re-press a held key
+        for (int i = 0; i < count; i++, t += period) {
+            int k = bench_keys[i % N_BENCH_KEYS];
+            bench_event *d = bench_add(evs, &n, t, k, 1);
+            bench_event *u = bench_add(evs, &n, t + hold, k, 0);
+            bench_expect(d, k, 1);
+            bench_expect(u, k, 0);
+        }
+    } else if (strcmp(workload, "chord") == 0) {  // param: keys per chord, pressed in a single frame
+        int keys = param < 1 ? 1 : param > N_BENCH_KEYS ? N_BENCH_KEYS : param;
+        for (int i = 0; i < count; i++, t += 2 * hold) {
+            for (int j = 0; j < keys; j++) bench_expect(bench_add(evs, &n, t, bench_keys[j], 1), bench_keys[j], 1);
+            for (int j = 0; j < keys; j++) bench_expect(bench_add(evs, &n, t + hold, bench_keys[j], 0), bench_keys[j], 0);
+        }
+    } else if (strcmp(workload, "chatter") == 0) {  // param: bounces after each press, bounce ms apart
+        int bounces = param < 0 ? 0 : param;
+        // the last bounce must re-press before the held release is flushed
+        if (2ULL * bounces * bounce + 4 >= (unsigned long long)timeout) {
+            int fit = timeout > 4 ? (timeout - 5) / (2 * bounce) : 0;
+            fprintf(stderr, "%d bounces %dms apart do not fit in the %dms timeout; using %d\n", bounces, bounce,
+                    timeout, fit);
+            bounces = fit;
+        }
+        for (int i = 0; i < count; i++, t += 2 * hold) {
+            int k = bench_keys[i % N_BENCH_KEYS];
+            bench_expect(bench_add(evs, &n, t, k, 1), k, 1);
+            for (int b = 0; b < bounces; b++) {
+                bench_add(evs, &n, t + (2 * b + 1) * bounce, k, 0);
+                bench_add(evs, &n, t + (2 * b + 2) * bounce, k, 1);
+            }
+            bench_expect(bench_add(evs, &n, t + hold, k, 0), k, 0);
+        }
+    } else if (strcmp(workload, "strafe") == 0) {  // param: direction changes per second on A/D
+        unsigned long long period = 1000 / (param > 0 ? param : 1);
+        if (period * 3 / 2 < hold) period = (hold * 2 + 2) / 3;
+        int cur = KEY_A;
+        bench_expect(bench_add(evs, &n, t, cur, 1), cur, 1);
+        for (int i = 0; i < count; i++) {
+            int other = cur == KEY_A ? KEY_D : KEY_A;
+            t += period;
+            bench_event *d = bench_add(evs, &n, t, other, 1);
+            bench_expect(d, cur, 0);  // FlashTap releases the held direction
+            bench_expect(d, other, 1);
+            bench_add(evs, &n, t + period / 2, cur, 0);
+            cur = other;
+        }
+        bench_expect(bench_add(evs, &n, t + period, cur, 0), cur, 0);
+    } else {
+        return -1;
+    }
+    qsort(evs, n, sizeof(bench_event), cmp_bench_event);
+    return n;
+}
+
+static int bench_source(char *path, size_t len) {
+    int fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
+    if (fd < 0) { perror("uinput open"); return -1; }
+    ioctl(fd, UI_SET_EVBIT, EV_KEY);
+    ioctl(fd, UI_SET_EVBIT, EV_SYN);
+    for (int i = 1; i < 256; i++) ioctl(fd, UI_SET_KEYBIT, i);
+    struct uinput_user_dev uidev = {0};
+    snprintf(uidev.name, UINPUT_MAX_NAME_SIZE, BENCH_SOURCE_NAME);
+    uidev.id.bustype = BUS_VIRTUAL;
+    uidev.id.vendor = 0x1234;
+    uidev.id.product = 0x5679;
+    uidev.id.version = 1;
+    if (write(fd, &uidev, sizeof(uidev)) != sizeof(uidev) || ioctl(fd, UI_DEV_CREATE) < 0) {
+        perror("uinput create");
+        close(fd);
+        return -1;
+    }
+    char sysname[64] = {0}, sysdir[PATH_MAX];
+    if (ioctl(fd, UI_GET_SYSNAME(sizeof(sysname)), sysname) < 0) { perror("UI_GET_SYSNAME"); close(fd); return -1; }
+    snprintf(sysdir, sizeof(sysdir), "/sys/class/input/%s", sysname);
+    path[0] = '\0';
+    for (int tries = 0; tries < 100 && (!path[0] || access(path, R_OK) != 0); tries++) {
+        DIR *dir = opendir(sysdir);
+        struct dirent *entry;
+        while (dir && (entry = readdir(dir)))
+            if (strncmp(entry->d_name, "event", 5) == 0) snprintf(path, len, "/dev/input/%s", entry->d_name);
+        if (dir) closedir(dir);
+        usleep(10000);
+    }
+    if (!path[0] || access(path, R_OK) != 0) { fprintf(stderr, "Bench source device node did not appear\n"); close(fd); return -1; }
+    return fd;
+}
+
+static int bench_output_open(void) {
+    for (int tries = 0; tries < 100; tries++) {
+        DIR *dir = opendir("/dev/input/");
+        struct dirent *entry;
+        while (dir && (entry = readdir(dir))) {
+            if (strncmp(entry->d_name, "event", 5) != 0) continue;
+            char path[PATH_MAX], name[256] = {0};
+            snprintf(path, sizeof(path), "/dev/input/%s", entry->d_name);
+            int fd = open(path, O_RDONLY | O_NONBLOCK);
+            if (fd < 0) continue;
+            ioctl(fd, EVIOCGNAME(sizeof(name)), name);
+            if (strcmp(name, BENCH_OUTPUT_NAME) == 0) {
+                closedir(dir);
+                int clk = CLOCK_MONOTONIC;
+                ioctl(fd, EVIOCSCLOCKID, &clk);
+                ioctl(fd, EVIOCGRAB, 1);  // keep synthetic keystrokes away from the desktop
+                return fd;
+            }
+            close(fd);
+        }
+        if (dir) closedir(dir);
+        usleep(10000);
+    }
+    fprintf(stderr, "Daemon output device did not appear\n");
+    return -1;
+}
+
+static void bench_drain(int fd, bench_output *out, int cap, int *nout, int *dropped) {
+    struct input_event evs[64];
+    ssize_t r;
+    while ((r = read(fd, evs, sizeof(evs))) > 0) {
+        for (int i = 0; i < r / (ssize_t)sizeof(evs[0]); i++) {
+            if (evs[i].type == EV_SYN && evs[i].code == SYN_DROPPED) (*dropped)++;
+            if (evs[i].type != EV_KEY || evs[i].value == 2) continue;
+            if (*nout < cap)
+                out[*nout] = (bench_output){evs[i].code, evs[i].value,
+                                            (unsigned long long)evs[i].time.tv_sec * 1000000ULL + evs[i].time.tv_usec};
+            (*nout)++;
+        }
+    }
+}
+
+static void bench_wait(int fd, unsigned long long until_us, bench_output *out, int cap, int *nout, int *dropped) {
+    unsigned long long now;
+    while ((now = mono_us()) < until_us) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        int ms = (int)((until_us - now) / 1000);
+        if (poll(&pfd, 1, ms) > 0) bench_drain(fd, out, cap, nout, dropped);
+    }
+    bench_drain(fd, out, cap, nout, dropped);
+}
+
+static int run_bench(const char *workload, int count, int param, int timeout, int bounce) {
+    uint8_t st[2] = {0};
+    if (query_status(st) < 0) return 1;
+    if (st[0] & STATUS_RUNNING) { fprintf(stderr, "Daemon is running; stop it before benchmarking.\n"); return 1; }
+    if (st[0] & STATUS_REMAP) fprintf(stderr, "Warning: a remap table is loaded; remapped keys will count as mismatches.\n");
+    int strafe = strcmp(workload, "strafe") == 0;
+    int per_cycle = 2 * (N_BENCH_KEYS > param ? N_BENCH_KEYS : param) + 4;
+    bench_event *evs = calloc((size_t)count * per_cycle + 2, sizeof(bench_event));
+    if (!evs) { perror("calloc"); return 1; }
+    int n = bench_schedule(evs, workload, count, param, timeout, bounce);
+    if (n < 0) { fprintf(stderr, "Workload must be one of: typing chord chatter strafe\n"); free(evs); return 1; }
+    int nexp = 0;
+    for (int i = 0; i < n; i++) nexp += evs[i].nexp;
+    int cap = nexp * 2 + 16, nout = 0, dropped = 0;
+    bench_output *out = calloc(cap, sizeof(bench_output));
+    unsigned long long *lat = calloc(nexp + 1, sizeof(unsigned long long));
+    char *used = calloc(cap, 1);
+    char src_path[PATH_MAX];
+    int src = out && lat && used ? bench_source(src_path, sizeof(src_path)) : -1;
+    if (src < 0) { free(evs); free(out); free(lat); free(used); return 1; }
+
+    char cmd[512];
+    snprintf(cmd, sizeof(cmd), "START %s %d %c %s user", src_path, timeout, strafe ? 'b' : 'd', strafe ? "ad" : "none");
+    int rc = 1, outfd = -1;
+    if (send_cmd(cmd) != 0) goto done;
+    outfd = bench_output_open();
+    if (outfd < 0) goto stop;
+
+    printf("Bench: %s, %d cycles, param %d, timeout %dms, %d input events\n", workload, count, param, timeout, n);
+    if (strcmp(workload, "chatter") == 0) printf("Bounce interval: %dms\n", bounce);
+    unsigned long long t0 = mono_us() + 100000;
+    for (int i = 0; i < n; i++) {
+        bench_wait(outfd, t0 + evs[i].at_us, out, cap, &nout, &dropped);
+        struct input_event ev[2] = {{.type = EV_KEY, .code = evs[i].code, .value = evs[i].value},
+                                    {.type = EV_SYN, .code = SYN_REPORT, .value = 0}};
+        int frame_end = i + 1 == n || evs[i + 1].at_us != evs[i].at_us;
+        evs[i].sent_us = mono_us();
+        ssize_t w = write(src, ev, frame_end ? sizeof(ev) : sizeof(ev[0]));
+        (void)w;
+    }
+    unsigned long long t_end = mono_us();
+    bench_wait(outfd, t_end + (timeout + 200) * 1000ULL, out, cap, &nout, &dropped);
+
+    // Match each expected event to the first unused output with the same code and value
+    // within the window around the previous match; frames may reorder keys, and a gap
+    // or an extra event must not shift every later comparison
+    int missing = 0, extra = 0, nlat = 0, kept = nout < cap ? nout : cap, first = 0, last = 0;
+    for (int i = 0; i < n; i++) {
+        for (int e = 0; e < evs[i].nexp; e++) {
+            int lo = last - first > BENCH_MATCH_WINDOW ? last - BENCH_MATCH_WINDOW : first;
+            int hi = last + BENCH_MATCH_WINDOW < kept ? last + BENCH_MATCH_WINDOW : kept;
+            int j = lo;
+            while (j < hi && (used[j] || out[j].code != evs[i].exp_code[e] || out[j].value != evs[i].exp_value[e])) j++;
+            if (j >= hi) {
+                missing++;
+                continue;
+            }
+            used[j] = 1;
+            last = j;
+            while (first < kept && used[first]) first++;
+            lat[nlat++] = out[j].time_us > evs[i].sent_us ? out[j].time_us - evs[i].sent_us : 0;
+        }
+    }
+    for (int j = 0; j < kept; j++) extra += !used[j];
+    extra += nout - kept;
+    qsort(lat, nlat, sizeof(lat[0]), cmp_ull);
+
+    double secs = (t_end - t0) / 1e6;
+    printf("Injected: %d events in %.2fs (%.0f ev/s)\n", n, secs, secs > 0 ? n / secs : 0);
+    printf("Received: %d key events, %d expected\n", nout, nexp);
+    if (dropped) printf("Output buffer overruns (SYN_DROPPED): %d\n", dropped);
+    printf("Missing: %d  Extra: %d\n", missing, extra);
+    if (nlat)
+        printf("Added latency (us): p50 %llu  p99 %llu  p999 %llu  max %llu\n", lat[nlat / 2],
+               lat[(size_t)nlat * 99 / 100], lat[(size_t)nlat * 999 / 1000], lat[nlat - 1]);
+    rc = missing || extra || dropped ? 1 : 0;
+
+stop:
+    if (outfd >= 0) close(outfd);
+    send_cmd("STOP");
+done:
+    ioctl(src, UI_DEV_DESTROY);
+    close(src);
+    free(evs);
+    free(out);
+    free(lat);
+    free(used);
+    return rc;
+}
+
 // ---------- Main ----------
 int main(int argc, char *argv[]) {
     if (argc < 2) { print_usage(argv[0]); return 0; }
     int timeout = 50;
     char mode = 'd';
     char ftpair[16] = "none";
+    char backend[8] = "user";
     char device[PATH_MAX] = {0};
     if (strcmp(argv[1], "stop") == 0 || strcmp(argv[1], "show") == 0 || strcmp(argv[1], "status") == 0 || strcmp(argv[1], "--help") == 0) {
         if (argc != 2) { fprintf(stderr, "%s does not take extra arguments\n", argv[1]); print_usage(argv[0]); return 1; }
@@ -188,16 +512,34 @@ int main(int argc, char *argv[]) {
         if (strcmp(argv[1], "show") == 0) return show_devices();
         if (strcmp(argv[1], "status") == 0) return show_status();
         if (strcmp(argv[1], "--help") == 0) { print_usage(argv[0]); return 0; }
+    } else if (strcmp(argv[1], "remap") == 0) {
+        if (argc != 3) { fprintf(stderr, "remap takes exactly one argument\n"); print_usage(argv[0]); return 1; }
+        char path[PATH_MAX];
+        if (strcmp(argv[2], "none") == 0) strcpy(path, "none");
+        else if (!realpath(argv[2], path)) { perror(argv[2]); return 1; }
+        char cmd[PATH_MAX + 8];
+        snprintf(cmd, sizeof(cmd), "REMAP %s", path);
+        return send_cmd(cmd);
+    } else if (strcmp(argv[1], "bench") == 0) {
+        if (argc < 3 || argc > 7) { fprintf(stderr, "bench takes 1 to 5 arguments\n"); print_usage(argv[0]); return 1; }
+        int count = argc >= 4 ? atoi(argv[3]) : 1000;
+        int param = argc >= 5 ? atoi(argv[4]) : strcmp(argv[2], "chord") == 0 ? 6 : strcmp(argv[2], "chatter") == 0 ? 3 : strcmp(argv[2], "strafe") == 0 ? 10 : 20;
+        if (argc >= 6) timeout = atoi(argv[5]);
+        int bounce = argc == 7 ? atoi(argv[6]) : 2;
+        if (count < 1) { fprintf(stderr, "count must be positive\n"); return 1; }
+        if (bounce < 1) { fprintf(stderr, "bounce must be positive\n"); return 1; }
+        return run_bench(argv[2], count, param, timeout, bounce);
     } else if (strcmp(argv[1], "start") == 0) {
-        if (argc < 3 || argc > 6) { fprintf(stderr, "Too many arguments; maximum 4 for start command.\n"); print_usage(argv[0]); return 1; }
-    } else { fprintf(stderr, "Command must be one of: stop show status start\n"); print_usage(argv[0]); return 1; }
+        if (argc < 3 || argc > 7) { fprintf(stderr, "Too many arguments; maximum 5 for start command.\n"); print_usage(argv[0]); return 1; }
+    } else { fprintf(stderr, "Command must be one of: stop show status start remap bench\n"); print_usage(argv[0]); return 1; }
     strncpy(device, argv[2], PATH_MAX - 1);
     if (argc >= 4) timeout = atoi(argv[3]);
     if (argc >= 5) mode = argv[4][0];
-    if (argc == 6) strncpy(ftpair, argv[5], sizeof(ftpair) - 1);
+    if (argc >= 6) strncpy(ftpair, argv[5], sizeof(ftpair) - 1);
+    if (argc == 7) strncpy(backend, argv[6], sizeof(backend) - 1);
     if (mode == 'd') strncpy(ftpair, "none", sizeof(ftpair) - 1);
     else if (ftpair[0] == 0) strncpy(ftpair, "ad", sizeof(ftpair) - 1);
     char cmd[512];
-    snprintf(cmd, sizeof(cmd), "START %s %d %c %s", device, timeout, mode, ftpair);
+    snprintf(cmd, sizeof(cmd), "START %s %d %c %s %s", device, timeout, mode, ftpair, backend);
     return send_cmd(cmd);
 }
\ No newline at end of file
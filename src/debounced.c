@@ -2,7 +2,6 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <inttypes.h>
-#include <libevdev/libevdev.h>
 #include <linux/input.h>
 #include <linux/uinput.h>
 #include <poll.h>
@@ -22,6 +21,10 @@
 #include <time.h>
 #include <unistd.h>
 
+#include "hid_bpf.h"
+#include "keynames.h"
+#include "probes.h"
+
 // ---------- Status ----------
 typedef struct {
     uint8_t status_byte;
@@ -34,7 +37,8 @@ typedef enum {
     CMD_NONE = 0,
     CMD_START,
     CMD_STOP,
-    CMD_STATUS
+    CMD_STATUS,
+    CMD_REMAP
 } cmd_type_t;
 
 #define DEVICE_PATH_MAX 255
@@ -45,6 +49,8 @@ typedef struct {
     uint8_t timeout_ms;
     char mode;
     char ftpair[16];
+    char remap_path[DEVICE_PATH_MAX];
+    char backend[8];
 } pending_cmd_t;
 
 static pending_cmd_t g_cmd = {0};
@@ -55,14 +61,18 @@ static pthread_cond_t g_cmd_done = PTHREAD_COND_INITIALIZER;
 
 // ---------- Bit masks ----------
 #define STATUS_RUNNING 0x80
+#define STATUS_REMAP 0x40
+#define STATUS_KERNEL 0x20
 #define STATUS_DEBOUNCE 0x08
 #define STATUS_FLASHTAP 0x04
 #define STATUS_PAIR_AD 0x02
 #define STATUS_PAIR_ARROWS 0x01
 
-#define MAX_KEYCODE 256
+#define MAX_KEYCODE (BTN_TASK + 1)  // keyboard keys plus BTN_MISC/BTN_MOUSE buttons
+#define READ_BATCH 64
 #define CONTROL_SOCKET_PATH "/run/debounced.sock"
 #define MAX_DEBOUNCE_MS 250
+#define DEFAULT_TAPTERM_MS 200
 
 // ---------- Globals ----------
 typedef struct {
@@ -70,6 +80,7 @@ typedef struct {
     unsigned long long down_time;
     int timerfd;
     unsigned long long last_event_ms;
+    int remap_out;  // keycode emitted for the current press, REMAP_LAYER, or -1
 } KeyState;
 
 static KeyState keys[KEY_MAX];
@@ -82,6 +93,8 @@ static char mode = 'd';
 static int ft_ad_enabled = 0, ft_arrows_enabled = 0;
 static int ft_active_ad = -1, ft_active_arrows = -1;
 static int verbose = 0;
+static int flashtap_on = 0;  // FlashTap mode with at least one pair enabled
+static int motion_unsynced = 0;  // forwarded motion awaiting SYN_REPORT; frames can straddle reads
 static unsigned long long start_time_ms = 0;
 
 // ---------- FlashTap struct ----------
@@ -92,12 +105,50 @@ typedef struct {
 static FlashPair pair_ad = {30, 32, {0, 0}};
 static FlashPair pair_ar = {105, 106, {0, 0}};
 
+// ---------- Remap table ----------
+#define REMAP_LAYER 0xFFFF  // action target meaning "hold the layer"
+
+typedef enum {
+    ACT_NONE = 0,
+    ACT_KEY,      // plain remap to tap
+    ACT_LAYER,    // layer key: layer table active while held
+    ACT_TAPHOLD   // dual role: tap on quick release, hold otherwise
+} act_kind_t;
+
+typedef struct {
+    uint8_t kind;
+    uint16_t tap;
+    uint16_t hold;
+} RemapAction;
+
+static RemapAction remap_base[MAX_KEYCODE], remap_layer[MAX_KEYCODE];
+static int remap_enabled = 0;
+static unsigned tapterm_ms = DEFAULT_TAPTERM_MS;
+static int layer_held = 0;
+static int th_pending = -1, th_timerfd = -1;
+
 // ---------- Key map ----------
+// key_names[] and key_codes[] are generated from linux/input-event-codes.h at build time
 static const char *key_name(int code) {
-    const char *n = libevdev_event_code_get_name(EV_KEY, code);
+    const char *n = (code >= 0 && code <= KEY_MAX) ? key_names[code] : NULL;
     return n ? n : "UNKNOWN";
 }
 
+static int key_code(const char *s) {
+    char *end;
+    long v = strtol(s, &end, 0);
+    if (*end != '\0') {
+        v = -1;
+        for (size_t i = 0; i < sizeof(key_codes) / sizeof(key_codes[0]); i++) {
+            if (strcmp(key_codes[i].name, s) == 0) {
+                v = key_codes[i].code;
+                break;
+            }
+        }
+    }
+    return (v >= 0 && v < MAX_KEYCODE) ? (int)v : -1;
+}
+
 // ---------- Mini helpers ----------
 static unsigned long long now_ms(void) {
     struct timespec ts;
@@ -107,6 +158,7 @@ static unsigned long long now_ms(void) {
 
 static void emit(int fd, int type, int code, int value, const struct timeval *tv) {
     struct input_event ev = {.type = type, .code = code, .value = value};
+    if (type == EV_KEY) PROBE3(emit, code, value, TV_US(tv));
     if (tv)
         ev.time = *tv;
     else
@@ -115,11 +167,185 @@ static void emit(int fd, int type, int code, int value, const struct timeval *tv
     (void)ret;
 }
 
+// Hot-path functions take their mode switches as constant arguments and are inlined
+// into one specialized batch handler per combination, see DEFINE_BATCH_HANDLER
+#define HOT static inline __attribute__((always_inline))
+
+#define BIT_SET(bits, n) ((bits)[(n) / 8] & (1 << ((n) % 8)))
+
+// Raw passthrough of already-framed events in one write
+static void forward_events(const struct input_event *evs, int n) {
+    ssize_t ret = write(fd_out, evs, n * sizeof(*evs));
+    (void)ret;
+}
+
 static void emit_key(int fd, int code, int value, const struct timeval *tv) {
     emit(fd, EV_KEY, code, value, tv);
     emit(fd, EV_SYN, SYN_REPORT, 0, tv);
 }
 
+static int arm_timer(unsigned long long delay_ms) {
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (tfd < 0) {
+        perror("timerfd_create");
+        return -1;
+    }
+    struct itimerspec its = {0};
+    its.it_value.tv_sec = delay_ms / 1000;
+    its.it_value.tv_nsec = (delay_ms % 1000) * 1000000ULL;
+    if (timerfd_settime(tfd, 0, &its, NULL) < 0) {
+        perror("timerfd_settime");
+        close(tfd);
+        return -1;
+    }
+    return tfd;
+}
+
+// Drop a pending debounce release; reason is one of TC_* from probes.h
+static void cancel_debounce_timer(int code, int reason, const struct timeval *tv) {
+    if (keys[code].timerfd >= 0) {
+        PROBE3(timer_cancel, code, reason, TV_US(tv));
+        close(keys[code].timerfd);
+        keys[code].timerfd = -1;
+    }
+}
+
+// ---------- Remap / layer stage ----------
+static void th_cancel(void) {
+    if (th_timerfd >= 0) {
+        close(th_timerfd);
+        th_timerfd = -1;
+    }
+    th_pending = -1;
+}
+
+// Pending dual-role key outlived the tapping term or was interrupted: commit to hold
+HOT void th_resolve_hold(const int log) {
+    int code = th_pending;
+    th_cancel();
+    keys[code].remap_out = remap_base[code].hold;
+    if (remap_base[code].hold == REMAP_LAYER) {
+        layer_held++;
+    } else {
+        emit_key(fd_out, remap_base[code].hold, 1, NULL);
+    }
+    if (log) printf("[RM] %s resolved as HOLD\n", key_name(code));
+}
+
+HOT void remap_event(int code, int value, const struct timeval *tv, const int rm, const int log) {
+    if (!rm) {
+        emit_key(fd_out, code, value, tv);
+        return;
+    }
+    KeyState *k = &keys[code];
+    if (value == 1) {  // down
+        if (th_pending >= 0 && th_pending != code) th_resolve_hold(log);
+        const RemapAction *a = &remap_base[code];
+        if (layer_held && remap_layer[code].kind != ACT_NONE) a = &remap_layer[code];
+        switch (a->kind) {
+            case ACT_LAYER:
+                k->remap_out = REMAP_LAYER;
+                layer_held++;
+                return;
+            case ACT_TAPHOLD:
+                th_cancel();
+                th_pending = code;
+                th_timerfd = arm_timer(tapterm_ms);
+                return;
+            case ACT_KEY:
+                k->remap_out = a->tap;
+                break;
+            default:
+                k->remap_out = code;
+                break;
+        }
+        emit_key(fd_out, k->remap_out, 1, tv);
+        if (log && k->remap_out != code) printf("[RM] %s -> %s\n", key_name(code), key_name(k->remap_out));
+    } else if (code == th_pending) {  // up or repeat inside the tapping term
+        if (value != 0) return;
+        th_cancel();
+        emit_key(fd_out, remap_base[code].tap, 1, tv);
+        emit_key(fd_out, remap_base[code].tap, 0, tv);
+        if (log) printf("[RM] %s resolved as TAP %s\n", key_name(code), key_name(remap_base[code].tap));
+    } else if (k->remap_out == REMAP_LAYER) {
+        if (value == 0) {
+            layer_held--;
+            k->remap_out = -1;
+        }
+    } else {
+        // Keys pressed before START have no recorded output and pass through as-is
+        emit_key(fd_out, k->remap_out >= 0 ? k->remap_out : code, value, tv);
+        if (value == 0) k->remap_out = -1;
+    }
+}
+
+// Parses a remap table file; "none" clears the table
+static int load_remap(const char *path) {
+    static RemapAction base[MAX_KEYCODE], layer[MAX_KEYCODE];
+    unsigned term = DEFAULT_TAPTERM_MS;
+    int entries = 0;
+    memset(base, 0, sizeof(base));
+    memset(layer, 0, sizeof(layer));
+    if (strcmp(path, "none") != 0) {
+        FILE *f = fopen(path, "r");
+        if (!f) {
+            perror("remap open");
+            return 1;
+        }
+        char line[256];
+        int lineno = 0;
+        while (fgets(line, sizeof(line), f)) {
+            lineno++;
+            char *hash = strchr(line, '#');
+            if (hash) *hash = '\0';
+            char *tok[6];
+            int n = 0;
+            for (char *t = strtok(line, " \t\r\n"); t && n < 6; t = strtok(NULL, " \t\r\n")) tok[n++] = t;
+            if (n == 0) continue;
+            int ok = 0;
+            if (n == 2 && strcasecmp(tok[0], "tapterm") == 0) {
+                term = (unsigned)atoi(tok[1]);
+                ok = term > 0 && term <= 1000;
+            } else if (n == 3 && strcasecmp(tok[0], "layer") == 0) {
+                int from = key_code(tok[1]), to = key_code(tok[2]);
+                if (from >= 0 && to >= 0) {
+                    layer[from] = (RemapAction){ACT_KEY, to, 0};
+                    ok = 1;
+                }
+            } else if (n == 2) {
+                int from = key_code(tok[0]);
+                if (from >= 0 && strcasecmp(tok[1], "layer") == 0) {
+                    base[from] = (RemapAction){ACT_LAYER, 0, 0};
+                    ok = 1;
+                } else if (from >= 0 && key_code(tok[1]) >= 0) {
+                    base[from] = (RemapAction){ACT_KEY, key_code(tok[1]), 0};
+                    ok = 1;
+                }
+            } else if (n == 5 && strcasecmp(tok[1], "tap") == 0 && strcasecmp(tok[3], "hold") == 0) {
+                int from = key_code(tok[0]), tap = key_code(tok[2]);
+                int hold = strcasecmp(tok[4], "layer") == 0 ? REMAP_LAYER : key_code(tok[4]);
+                if (from >= 0 && tap >= 0 && hold >= 0) {
+                    base[from] = (RemapAction){ACT_TAPHOLD, tap, hold};
+                    ok = 1;
+                }
+            }
+            if (!ok) {
+                fprintf(stderr, "%s:%d: invalid remap entry\n", path, lineno);
+                fclose(f);
+                return 1;
+            }
+            entries++;
+        }
+        fclose(f);
+    }
+    memcpy(remap_base, base, sizeof(base));
+    memcpy(remap_layer, layer, sizeof(layer));
+    tapterm_ms = term;
+    remap_enabled = entries > 0;
+    printf("REMAP %s: %d entries, tapterm=%ums\n", path, entries, tapterm_ms);
+    return 0;
+}
+
 // ---------- State reset function ----------
 static void reset_state(void) {
     // Release grabbed input device
@@ -140,21 +366,33 @@ static void reset_state(void) {
     }
     // Clear key states
     for (int k = 0; k < MAX_KEYCODE; k++) {
-        if (keys[k].timerfd >= 0) {
-            close(keys[k].timerfd);
-            keys[k].timerfd = -1;
-        }
+        cancel_debounce_timer(k, TC_RESET, NULL);
         keys[k].pressed = 0;
         keys[k].down_time = 0;
         keys[k].last_event_ms = 0;
+        keys[k].remap_out = -1;
     }
+    th_cancel();
+    layer_held = 0;
+    hidbpf_detach();
     ft_active_ad = ft_active_arrows = -1;
-    g_status.status_byte = 0;
+    g_status.status_byte = remap_enabled ? STATUS_REMAP : 0;
     g_status.timeout_ms = 0;
 }
 
+static void set_running_status(uint8_t extra) {
+    g_status.status_byte = STATUS_RUNNING | extra;
+    if (remap_enabled) g_status.status_byte |= STATUS_REMAP;
+    if (mode == 'd' || mode == 'b') g_status.status_byte |= STATUS_DEBOUNCE;
+    if (ft_ad_enabled || ft_arrows_enabled) g_status.status_byte |= STATUS_FLASHTAP;
+    if (ft_ad_enabled) g_status.status_byte |= STATUS_PAIR_AD;
+    if (ft_arrows_enabled) g_status.status_byte |= STATUS_PAIR_ARROWS;
+    g_status.timeout_ms = debounce_ms;
+}
+
 // ---------- Virtual keyboard instantiation ----------
-static int setup_uinput(void) {
+// Mirrors the source's keys, relative/absolute axes and properties so mice pass through intact
+static int setup_uinput(int src) {
     int fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
     if (fd < 0) {
         perror("uinput open");
@@ -165,8 +403,37 @@ static int setup_uinput(void) {
         close(fd);
         return -1;
     }
-    for (int i = 0; i < MAX_KEYCODE; i++) ioctl(fd, UI_SET_KEYBIT, i);
     struct uinput_user_dev uidev = {0};
+    uint8_t key_bits[(KEY_MAX + 8) / 8] = {0};
+    ioctl(src, EVIOCGBIT(EV_KEY, sizeof(key_bits)), key_bits);
+    for (int i = 0; i <= KEY_MAX; i++)
+        if (i < BTN_MISC || BIT_SET(key_bits, i)) ioctl(fd, UI_SET_KEYBIT, i);
+    uint8_t rel_bits[(REL_MAX + 8) / 8] = {0};
+    if (ioctl(src, EVIOCGBIT(EV_REL, sizeof(rel_bits)), rel_bits) > 0) {
+        for (int i = 0; i <= REL_MAX; i++) {
+            if (!BIT_SET(rel_bits, i)) continue;
+            ioctl(fd, UI_SET_EVBIT, EV_REL);
+            ioctl(fd, UI_SET_RELBIT, i);
+        }
+    }
+    uint8_t abs_bits[(ABS_MAX + 8) / 8] = {0};
+    if (ioctl(src, EVIOCGBIT(EV_ABS, sizeof(abs_bits)), abs_bits) > 0) {
+        for (int i = 0; i <= ABS_MAX; i++) {
+            struct input_absinfo ai;
+            if (!BIT_SET(abs_bits, i) || ioctl(src, EVIOCGABS(i), &ai) < 0) continue;
+            ioctl(fd, UI_SET_EVBIT, EV_ABS);
+            ioctl(fd, UI_SET_ABSBIT, i);
+            uidev.absmin[i] = ai.minimum;
+            uidev.absmax[i] = ai.maximum;
+            uidev.absfuzz[i] = ai.fuzz;
+            uidev.absflat[i] = ai.flat;
+        }
+    }
+    uint8_t prop_bits[(INPUT_PROP_MAX + 8) / 8] = {0};
+    if (ioctl(src, EVIOCGPROP(sizeof(prop_bits)), prop_bits) > 0) {
+        for (int i = 0; i <= INPUT_PROP_MAX; i++)
+            if (BIT_SET(prop_bits, i)) ioctl(fd, UI_SET_PROPBIT, i);
+    }
     snprintf(uidev.name, UINPUT_MAX_NAME_SIZE, "debounced-virtual-keyboard");
     uidev.id.bustype = BUS_USB;
     uidev.id.vendor = 0x1234;
@@ -179,7 +446,7 @@ static int setup_uinput(void) {
 }
 
 // ---------- FlashTap logic ----------
-static void handle_flashtap(int code, int value) {
+HOT void handle_flashtap(int code, int value, const struct timeval *tv, const int rm, const int log) {
     FlashPair *fp = NULL;
     int *ft_active_ptr = NULL;
     if (ft_ad_enabled && (code == pair_ad.key1 || code == pair_ad.key2)) {
@@ -195,20 +462,21 @@ static void handle_flashtap(int code, int value) {
     fp->phys[idx] = (value != 0);
     if (value == 1) {  // down
         if (*ft_active_ptr == other) {
-            emit_key(fd_out, other, 0, NULL);
+            PROBE3(flashtap, other, code, TV_US(tv));
+            remap_event(other, 0, NULL, rm, log);
             printf("[FT] Released %s due to %s press\n", key_name(other), key_name(code));
         }
         *ft_active_ptr = code;
-        emit_key(fd_out, code, 1, NULL);
-        if (verbose) fprintf(stderr, "[FT] %s DOWN\n", key_name(code));
+        remap_event(code, 1, NULL, rm, log);
+        if (log) fprintf(stderr, "[FT] %s DOWN\n", key_name(code));
     } else if (value == 0) {  // up
         if (*ft_active_ptr == code) {
             *ft_active_ptr = -1;
-            emit_key(fd_out, code, 0, NULL);
-            if (verbose) printf("[FT] %s UP\n", key_name(code));
+            remap_event(code, 0, NULL, rm, log);
+            if (log) printf("[FT] %s UP\n", key_name(code));
             if (fp->phys[1 - idx]) {
                 *ft_active_ptr = other;
-                emit_key(fd_out, other, 1, NULL);
+                remap_event(other, 1, NULL, rm, log);
                 printf("[FT] %s state restored to %s due to %s release\n", key_name(other),
                        fp->phys[1 - idx] ? "DOWN" : "UP", key_name(code));
             }
@@ -217,55 +485,41 @@ static void handle_flashtap(int code, int value) {
 }
 
 // ---------- Post-debounce event router ----------
-static void post_debounce_event(int code, int value, const struct timeval *tv) {
-    if ((mode == 'f' || mode == 'b') &&
-        ((ft_ad_enabled && (code == pair_ad.key1 || code == pair_ad.key2)) ||
-         (ft_arrows_enabled && (code == pair_ar.key1 || code == pair_ar.key2)))) {
-        handle_flashtap(code, value);
+HOT void post_debounce_event(int code, int value, const struct timeval *tv, const int ft, const int rm,
+                             const int log) {
+    if (ft && ((ft_ad_enabled && (code == pair_ad.key1 || code == pair_ad.key2)) ||
+               (ft_arrows_enabled && (code == pair_ar.key1 || code == pair_ar.key2)))) {
+        handle_flashtap(code, value, tv, rm, log);
     } else {
-        emit_key(fd_out, code, value, tv);
+        remap_event(code, value, tv, rm, log);
     }
 }
 
 // ---------- Debounce timers ----------
-static void start_debounce_timer(int code, unsigned long long delay_ms) {
-    if (keys[code].timerfd >= 0) {
-        close(keys[code].timerfd);
-        keys[code].timerfd = -1;
-    }
-    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
-    if (tfd < 0) {
-        perror("timerfd_create");
-        return;
-    }
-    struct itimerspec its = {0};
-    its.it_value.tv_sec = delay_ms / 1000;
-    its.it_value.tv_nsec = (delay_ms % 1000) * 1000000ULL;
-    if (timerfd_settime(tfd, 0, &its, NULL) < 0) {
-        perror("timerfd_settime");
-        close(tfd);
-        return;
-    }
-    keys[code].timerfd = tfd;
+static void start_debounce_timer(int code, unsigned long long delay_ms, const struct timeval *tv) {
+    cancel_debounce_timer(code, TC_REARM, tv);
+    keys[code].timerfd = arm_timer(delay_ms);
+    PROBE3(timer_arm, code, delay_ms, TV_US(tv));
 }
 
 // ---------- Debounce processing ----------
-static void process_debounce(int code, int value, const struct timeval *tv) {
+HOT void process_debounce(int code, int value, const struct timeval *tv, const int ft, const int rm, const int log) {
     unsigned long long now = now_ms();
     unsigned long long delta = now - keys[code].last_event_ms;  // compute delta before updating
     keys[code].last_event_ms = now;
     if (value == 1) {  // DOWN
 
         if (!keys[code].pressed) {
-            post_debounce_event(code, 1, tv);
+            PROBE4(debounce, code, value, DB_PASS, TV_US(tv));
+            post_debounce_event(code, 1, tv, ft, rm, log);
             keys[code].pressed = 1;
             keys[code].down_time = now;
             keys[code].timerfd = -1;
-            if (verbose) printf("[DB] %s DOWN, %llu ms since last event\n", key_name(code), delta);
+            if (log) printf("[DB] %s DOWN, %llu ms since last event\n", key_name(code), delta);
         } else if (keys[code].timerfd > 0) {
-            close(keys[code].timerfd);
-            keys[code].timerfd = -1;
-            if (!verbose)
+            PROBE4(debounce, code, value, DB_CANCEL_UP, TV_US(tv));
+            cancel_debounce_timer(code, TC_REPRESS, tv);
+            if (!log)
                 printf("[DB] %s DOWN canceled pending UP\n", key_name(code));  // quiet mode
             else
                 printf("[DB] %s DOWN canceled pending UP, %llu ms since last event\n", key_name(code), delta);
@@ -274,26 +528,97 @@ static void process_debounce(int code, int value, const struct timeval *tv) {
         unsigned long long elapsed = now - keys[code].down_time;
         if (elapsed < debounce_ms) {
             // arm timer using helper
-            start_debounce_timer(code, debounce_ms - elapsed);
-            if (verbose)
+            PROBE4(debounce, code, value, DB_UP_PENDING, TV_US(tv));
+            start_debounce_timer(code, debounce_ms - elapsed, tv);
+            if (log)
                 printf("[DB] %s UP pending, %llu ms since press, flush after %ums, %llu ms since last event\n",
                        key_name(code), (unsigned long long)elapsed, (unsigned)(debounce_ms - elapsed), delta);
         } else {
-            post_debounce_event(code, 0, tv);
+            PROBE4(debounce, code, value, DB_PASS, TV_US(tv));
+            post_debounce_event(code, 0, tv, ft, rm, log);
             keys[code].pressed = 0;
             keys[code].timerfd = -1;
-            if (verbose) printf("[DB] %s UP immediate, %llu ms since last event\n", key_name(code), delta);
+            if (log) printf("[DB] %s UP immediate, %llu ms since last event\n", key_name(code), delta);
         }
     } else if (value == 2) {  // REPEAT
         if (keys[code].pressed) {
-            emit_key(fd_out, code, 2, tv);
-            if (verbose) printf("[DB] %s REPEAT\n", key_name(code));
+            PROBE4(debounce, code, value, DB_REPEAT, TV_US(tv));
+            remap_event(code, 2, tv, rm, log);
+            if (log) printf("[DB] %s REPEAT\n", key_name(code));
         } else {
-            if (verbose) printf("[DB] Ignored %s REPEAT (key not pressed)\n", key_name(code));
+            PROBE4(debounce, code, value, DB_IGNORED, TV_US(tv));
+            if (log) printf("[DB] Ignored %s REPEAT (key not pressed)\n", key_name(code));
         }
     }
 }
 
+// ---------- Input batch handler ----------
+HOT void handle_batch(const struct input_event *evs, int n, const int db, const int ft, const int rm, const int log) {
+    struct input_event raw[READ_BATCH + 1];
+    int nraw = 0;
+    for (int i = 0; i < n; i++) {
+        const struct input_event *ev = &evs[i];
+        if (ev->type == EV_KEY && ev->code < MAX_KEYCODE) {
+            PROBE3(event_read, ev->code, ev->value, TV_US(&ev->time));
+            // raw events queued ahead of a debounced key go out as their own frame to keep ordering
+            if (nraw) {
+                if (motion_unsynced) raw[nraw++] = (struct input_event){ev->time, EV_SYN, SYN_REPORT, 0};
+                forward_events(raw, nraw);
+                nraw = motion_unsynced = 0;
+            }
+            if (db)
+                process_debounce(ev->code, ev->value, &ev->time, ft, rm, log);
+            else
+                post_debounce_event(ev->code, ev->value, &ev->time, ft, rm, log);
+        } else if (ev->type == EV_KEY || ev->type == EV_REL || ev->type == EV_ABS) {
+            // motion and touch/tool buttons (BTN_TOUCH, BTN_TOOL_*) stay in their original frame
+            raw[nraw++] = *ev;
+            motion_unsynced = 1;
+        } else if (ev->type == EV_SYN && ev->code != SYN_DROPPED && motion_unsynced) {
+            raw[nraw++] = *ev;
+            if (ev->code == SYN_REPORT) motion_unsynced = 0;  // SYN_MT_REPORT stays inside the frame
+        }
+    }
+    if (nraw) forward_events(raw, nraw);
+}
+
+typedef void (*batch_handler_t)(const struct input_event *evs, int n);
+
+#define DEFINE_BATCH_HANDLER(db, ft, rm, log)                                          \
+    static void handle_batch_##db##ft##rm##log(const struct input_event *evs, int n) { \
+        handle_batch(evs, n, db, ft, rm, log);                                         \
+    }
+
+DEFINE_BATCH_HANDLER(0, 0, 0, 0)
+DEFINE_BATCH_HANDLER(0, 0, 0, 1)
+DEFINE_BATCH_HANDLER(0, 0, 1, 0)
+DEFINE_BATCH_HANDLER(0, 0, 1, 1)
+DEFINE_BATCH_HANDLER(0, 1, 0, 0)
+DEFINE_BATCH_HANDLER(0, 1, 0, 1)
+DEFINE_BATCH_HANDLER(0, 1, 1, 0)
+DEFINE_BATCH_HANDLER(0, 1, 1, 1)
+DEFINE_BATCH_HANDLER(1, 0, 0, 0)
+DEFINE_BATCH_HANDLER(1, 0, 0, 1)
+DEFINE_BATCH_HANDLER(1, 0, 1, 0)
+DEFINE_BATCH_HANDLER(1, 0, 1, 1)
+DEFINE_BATCH_HANDLER(1, 1, 0, 0)
+DEFINE_BATCH_HANDLER(1, 1, 0, 1)
+DEFINE_BATCH_HANDLER(1, 1, 1, 0)
+DEFINE_BATCH_HANDLER(1, 1, 1, 1)
+
+// Indexed [debounce][flashtap][remap][verbose]; chosen once per START
+static const batch_handler_t batch_handlers[2][2][2][2] = {
+    {
+        {{handle_batch_0000, handle_batch_0001}, {handle_batch_0010, handle_batch_0011}},
+        {{handle_batch_0100, handle_batch_0101}, {handle_batch_0110, handle_batch_0111}},
+    },
+    {
+        {{handle_batch_1000, handle_batch_1001}, {handle_batch_1010, handle_batch_1011}},
+        {{handle_batch_1100, handle_batch_1101}, {handle_batch_1110, handle_batch_1111}},
+    },
+};
+static batch_handler_t handle_input = handle_batch_1000;
+
 // ---------- SIGTERM handler ----------
 static void handle_sigterm(int signum) {
     (void)signum;
@@ -353,6 +678,7 @@ static void *socket_thread_fn(void *arg) {
             char *t    = strtok(NULL, " \t\n");
             char *m    = strtok(NULL, " \t\n");
             char *pair = strtok(NULL, " \t\n");
+            char *backend = strtok(NULL, " \t\n");
             if (!dev || !t || !m || !pair) {
                 pthread_mutex_unlock(&g_cmd_mutex);
                 close(c);
@@ -365,8 +691,20 @@ static void *socket_thread_fn(void *arg) {
             g_cmd.mode = m[0];
             strncpy(g_cmd.ftpair, pair, sizeof(g_cmd.ftpair) - 1);
             g_cmd.ftpair[sizeof(g_cmd.ftpair) - 1] = '\0';
+            strncpy(g_cmd.backend, backend ? backend : "user", sizeof(g_cmd.backend) - 1);
+            g_cmd.backend[sizeof(g_cmd.backend) - 1] = '\0';
         } else if (strncasecmp(cmd, "STATUS", 6) == 0) {
             g_cmd.type = CMD_STATUS;
+        } else if (strncasecmp(cmd, "REMAP", 5) == 0) {
+            char *path = strtok(NULL, " \t\n");
+            if (!path) {
+                pthread_mutex_unlock(&g_cmd_mutex);
+                close(c);
+                continue;
+            }
+            g_cmd.type = CMD_REMAP;
+            strncpy(g_cmd.remap_path, path, DEVICE_PATH_MAX - 1);
+            g_cmd.remap_path[DEVICE_PATH_MAX - 1] = '\0';
         } else {
             pthread_mutex_unlock(&g_cmd_mutex);
             close(c);
@@ -411,7 +749,7 @@ int main(int argc, char *argv[]) {
         fprintf(stderr, "You need uinput support for this program to function.\n");
         return 2;
     }
-    for (int i = 0; i < KEY_MAX; i++) keys[i].timerfd = -1;
+    for (int i = 0; i < KEY_MAX; i++) keys[i].timerfd = keys[i].remap_out = -1;
     signal(SIGTERM, handle_sigterm);
     pthread_create(&sock_thread, NULL, socket_thread_fn, NULL);
     printf("Debounced daemon ready%s.\n", verbose ? " (verbose)" : "");
@@ -428,8 +766,15 @@ int main(int argc, char *argv[]) {
                 clock_gettime(CLOCK_REALTIME, &ts);
                 ts.tv_sec += 1; // wake up every second to check flags
                 pthread_cond_timedwait(&g_cmd_pending, &g_cmd_mutex, &ts);
+                if ((g_status.status_byte & STATUS_KERNEL) && !hidbpf_device_present()) break;
             }
             pthread_mutex_unlock(&g_cmd_mutex);
+            // The HID-BPF backend has no input fd, so watch its HID device instead
+            if ((g_status.status_byte & STATUS_KERNEL) && !hidbpf_device_present()) {
+                fprintf(stderr, "HID device disappeared. Stopping and resetting state.\n");
+                reset_state();
+                continue;
+            }
         }
 
         // Check for pending command
@@ -458,6 +803,20 @@ int main(int argc, char *argv[]) {
                     printf("START %s mode=%c debounce=%ums FT ad=%d arrows=%d\n",
                            g_cmd.device, mode, debounce_ms, ft_ad_enabled, ft_arrows_enabled);
 
+                    // Kernel-resident backend, userspace path below remains the fallback
+                    if (strcasecmp(g_cmd.backend, "bpf") == 0) {
+                        if (remap_enabled) {
+                            fprintf(stderr, "HID-BPF backend cannot remap keys, using userspace backend.\n");
+                        } else if (hidbpf_attach(g_cmd.device, mode == 'f' ? 0 : debounce_ms,
+                                                 mode != 'd' && ft_ad_enabled, mode != 'd' && ft_arrows_enabled) == 0) {
+                            set_running_status(STATUS_KERNEL);
+                            g_cmd_result = 0;
+                            break;
+                        } else {
+                            fprintf(stderr, "Falling back to userspace backend.\n");
+                        }
+                    }
+
                     fd_in = open(g_cmd.device, O_RDONLY);
                     if (fd_in < 0) { perror("input open"); g_cmd_result = 1; break; }
 
@@ -473,6 +832,10 @@ int main(int argc, char *argv[]) {
                         close(fd_in_write);
                     }
 
+                    // Event timestamps on the same clock as now_ms() and the trace probes
+                    int clk = CLOCK_MONOTONIC;
+                    ioctl(fd_in, EVIOCSCLOCKID, &clk);
+
                     if (ioctl(fd_in, EVIOCGRAB, 1) < 0) {
                         perror("grab");
                         close(fd_in);
@@ -481,7 +844,7 @@ int main(int argc, char *argv[]) {
                         break;
                     }
 
-                    fd_out = setup_uinput();
+                    fd_out = setup_uinput(fd_in);
                     if (fd_out < 0) {
                         close(fd_in);
                         fd_in = -1;
@@ -489,18 +852,21 @@ int main(int argc, char *argv[]) {
                         break;
                     }
 
-                    // Reset key state
+                    // Reset key state and pick the event handler for this mode
+                    flashtap_on = (mode == 'f' || mode == 'b') && (ft_ad_enabled || ft_arrows_enabled);
+                    handle_input = batch_handlers[mode != 'f'][flashtap_on][remap_enabled][verbose];
+                    motion_unsynced = 0;
                     ft_active_ad = ft_active_arrows = -1;
                     start_time_ms = now_ms();
                     for (int k = 0; k < MAX_KEYCODE; k++) {
                         keys[k].pressed = 0;
                         keys[k].down_time = 0;
-                        if (keys[k].timerfd >= 0) {
-                            close(keys[k].timerfd);
-                            keys[k].timerfd = -1;
-                        }
+                        cancel_debounce_timer(k, TC_RESET, NULL);
                         keys[k].last_event_ms = 0;
+                        keys[k].remap_out = -1;
                     }
+                    th_cancel();
+                    layer_held = 0;
 
                     // Sync initial key state from hardware
                     uint8_t key_bits[(MAX_KEYCODE + 7) / 8] = {0};
@@ -512,12 +878,7 @@ int main(int argc, char *argv[]) {
                         }
                     }
 
-                    g_status.status_byte = STATUS_RUNNING;
-                    if (mode == 'd' || mode == 'b') g_status.status_byte |= STATUS_DEBOUNCE;
-                    if (ft_ad_enabled || ft_arrows_enabled) g_status.status_byte |= STATUS_FLASHTAP;
-                    if (ft_ad_enabled) g_status.status_byte |= STATUS_PAIR_AD;
-                    if (ft_arrows_enabled) g_status.status_byte |= STATUS_PAIR_ARROWS;
-                    g_status.timeout_ms = debounce_ms;
+                    set_running_status(0);
 
                     g_cmd_result = 0;
                     break;
@@ -534,54 +895,61 @@ int main(int argc, char *argv[]) {
                 case CMD_STATUS:
                     g_cmd_result = 0; // result unused for STATUS, socket thread reads g_status directly
                     break;
+                case CMD_REMAP:
+                    if (g_status.status_byte & STATUS_RUNNING) {
+                        fprintf(stderr, "REMAP received but daemon running, ignoring.\n");
+                        g_cmd_result = 1;
+                        break;
+                    }
+                    g_cmd_result = load_remap(g_cmd.remap_path);
+                    g_status.status_byte = remap_enabled ? STATUS_REMAP : 0;
+                    break;
                 default:
                     break;
             }
+            PROBE2(command, g_cmd.type, g_cmd_result);
             g_cmd.type = CMD_NONE;
             pthread_cond_signal(&g_cmd_done);
         }
         pthread_mutex_unlock(&g_cmd_mutex);
         if (fd_in < 0) continue;
-        int version;
-        // Check if device disappeared
-        if (ioctl(fd_in, EVIOCGVERSION, &version) < 0) {
-            fprintf(stderr, "Keyboard device disappeared. Stopping and resetting state.\n");
-            reset_state();
-            continue;
-        }
-        struct pollfd pfds[MAX_KEYCODE + 1];
+        struct pollfd pfds[MAX_KEYCODE + 2];
         int nfds = 0;
         pfds[nfds++] = (struct pollfd){fd_in, POLLIN, 0};
+        if (th_timerfd >= 0) pfds[nfds++] = (struct pollfd){th_timerfd, POLLIN, 0};
         for (int k = 0; k < MAX_KEYCODE; k++)
             if (keys[k].timerfd >= 0) pfds[nfds++] = (struct pollfd){keys[k].timerfd, POLLIN, 0};
         int ret = poll(pfds, nfds, -1);
         if (ret <= 0) continue;
         // check input device
         if (pfds[0].revents & POLLIN) {
-            struct input_event ev;
-            ssize_t r = read(fd_in, &ev, sizeof(ev));
-            if (r == sizeof(ev) && ev.type == EV_KEY) {
-                if (ev.code < MAX_KEYCODE) {
-                    if (mode == 'f')
-                        post_debounce_event(ev.code, ev.value, &ev.time);
-                    else
-                        process_debounce(ev.code, ev.value, &ev.time);
-                } else {
-                    emit_key(fd_out, ev.code, ev.value, &ev.time);
-                }
-            }
+            struct input_event evs[READ_BATCH];
+            ssize_t r = read(fd_in, evs, sizeof(evs));
+            if (r < 0 && errno == ENODEV) pfds[0].revents |= POLLERR;
+            if (r > 0) handle_input(evs, r / sizeof(evs[0]));
+        }
+        // Check if device disappeared
+        if (pfds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            fprintf(stderr, "Input device disappeared. Stopping and resetting state.\n");
+            reset_state();
+            continue;
         }
         // check timers
         for (int i = 1; i < nfds; i++) {
             if (pfds[i].revents & POLLIN) {
                 unsigned long long expir;
                 ssize_t ret = read(pfds[i].fd, &expir, sizeof(expir));
-                (void)ret;
+                if (ret != sizeof(expir)) continue;  // timer was cancelled earlier in this pass
+                if (pfds[i].fd == th_timerfd) {
+                    if (th_pending >= 0) th_resolve_hold(verbose);
+                    continue;
+                }
                 for (int k = 0; k < MAX_KEYCODE; k++) {
                     if (keys[k].timerfd == pfds[i].fd) {
                         unsigned long long now = now_ms();
                         unsigned long long delta = now - keys[k].last_event_ms;
-                        post_debounce_event(k, 0, NULL);
+                        PROBE3(timer_fire, k, expir, now * 1000ULL);
+                        post_debounce_event(k, 0, NULL, flashtap_on, remap_enabled, verbose);
                         keys[k].pressed = 0;
                         close(keys[k].timerfd);
                         keys[k].timerfd = -1;
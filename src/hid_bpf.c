@@ -0,0 +1,110 @@
+#define _GNU_SOURCE
+#include <bpf/bpf.h>
+#include <bpf/libbpf.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <limits.h>
+#include <linux/types.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bpf/debounce_bpf.h"
+#include "debounce.skel.h"
+#include "hid_bpf.h"
+
+static struct debounce_bpf *skel;
+static struct bpf_link *hid_link;
+static char hid_name[64];  // HID device the program is attached to
+
+// ---------- HID device lookup ----------
+// Resolves an evdev node to its HID parent, e.g. 0003:046D:C31C.0005, and returns the HID id
+static int hid_device_of(const char *device, char *name, size_t len) {
+    char real[PATH_MAX], sys[PATH_MAX], parent[PATH_MAX];
+    if (!realpath(device, real)) return -1;
+    snprintf(sys, sizeof(sys), "/sys/class/input/%s/device/device", basename(real));
+    if (!realpath(sys, parent)) return -1;
+    const char *base = basename(parent);
+    unsigned bus, vid, pid, id;
+    if (sscanf(base, "%x:%x:%x.%x", &bus, &vid, &pid, &id) != 4) return -1;
+    snprintf(name, len, "%s", base);
+    return (int)id;
+}
+
+// The BPF program only understands the 8-byte boot keyboard report without report IDs
+static int is_boot_keyboard(const char *name) {
+    char path[PATH_MAX];
+    uint8_t rd[4096];
+    snprintf(path, sizeof(path), "/sys/bus/hid/devices/%s/report_descriptor", name);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+    ssize_t n = read(fd, rd, sizeof(rd));
+    close(fd);
+    static const uint8_t kbd_prefix[] = {0x05, 0x01, 0x09, 0x06, 0xA1, 0x01};
+    if (n < (ssize_t)sizeof(kbd_prefix) || memcmp(rd, kbd_prefix, sizeof(kbd_prefix)) != 0) return 0;
+    for (ssize_t i = 0; i < n;) {
+        uint8_t size = rd[i] & 0x03;
+        if (size == 3) size = 4;
+        if ((rd[i] & 0xFC) == 0x84) return 0;  // Report ID item
+        i += 1 + size;
+    }
+    return 1;
+}
+
+// ---------- Attach / detach ----------
+int hidbpf_attach(const char *device, unsigned debounce_ms, int ft_ad, int ft_arrows) {
+    char name[64];
+    int hid_id = hid_device_of(device, name, sizeof(name));
+    if (hid_id < 0 || !is_boot_keyboard(name)) {
+        fprintf(stderr, "HID-BPF: %s is not a boot-protocol HID keyboard\n", device);
+        return -1;
+    }
+    skel = debounce_bpf__open();
+    if (!skel) {
+        perror("HID-BPF open");
+        return -1;
+    }
+    skel->struct_ops.debounce_ops->hid_id = hid_id;
+    if (debounce_bpf__load(skel)) goto fail;
+
+    struct db_config cfg = {
+        .debounce_ns = debounce_ms * 1000000ULL,
+        .hid_id = hid_id,
+        .ft_ad = ft_ad,
+        .ft_arrows = ft_arrows,
+    };
+    __u32 key = 0;
+    if (bpf_map__update_elem(skel->maps.config, &key, sizeof(key), &cfg, sizeof(cfg), BPF_ANY)) goto fail;
+
+    LIBBPF_OPTS(bpf_test_run_opts, run);
+    if (bpf_prog_test_run_opts(bpf_program__fd(skel->progs.init_deferred), &run) || run.retval) goto fail;
+
+    hid_link = bpf_map__attach_struct_ops(skel->maps.debounce_ops);
+    if (!hid_link) goto fail;
+    snprintf(hid_name, sizeof(hid_name), "%s", name);
+    printf("HID-BPF backend attached to %s\n", name);
+    return 0;
+
+fail:
+    fprintf(stderr, "HID-BPF: failed to load program for %s\n", name);
+    hidbpf_detach();
+    return -1;
+}
+
+void hidbpf_detach(void) {
+    bpf_link__destroy(hid_link);
+    hid_link = NULL;
+    debounce_bpf__destroy(skel);
+    skel = NULL;
+    hid_name[0] = '\0';
+}
+
+// There is no input fd to report an unplug, so the main loop polls sysfs instead
+int hidbpf_device_present(void) {
+    char path[PATH_MAX];
+    if (!hid_name[0]) return 0;
+    snprintf(path, sizeof(path), "/sys/bus/hid/devices/%s", hid_name);
+    return access(path, F_OK) == 0;
+}
@@ -0,0 +1,23 @@
+#ifndef DEBOUNCED_HID_BPF_H
+#define DEBOUNCED_HID_BPF_H
+
+// Optional kernel-resident backend, built with BPF=1. Without it START always
+// uses the userspace path.
+#ifdef DEBOUNCED_HID_BPF
+int hidbpf_attach(const char *device, unsigned debounce_ms, int ft_ad, int ft_arrows);
+void hidbpf_detach(void);
+int hidbpf_device_present(void);
+#else
+static inline int hidbpf_attach(const char *device, unsigned debounce_ms, int ft_ad, int ft_arrows) {
+    (void)device;
+    (void)debounce_ms;
+    (void)ft_ad;
+    (void)ft_arrows;
+    fprintf(stderr, "HID-BPF backend not compiled in.\n");
+    return -1;
+}
+static inline void hidbpf_detach(void) {}
+static inline int hidbpf_device_present(void) { return 0; }
+#endif
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef DEBOUNCED_PROBES_H
+#define DEBOUNCED_PROBES_H
+
+// USDT tracepoints for bpftrace/perf. Each probe compiles to a single nop plus an
+// ELF note, so disabled probes cost nothing. Build with SDT=0 to drop them entirely.
+//
+// Timestamps are CLOCK_MONOTONIC microseconds (the input device clock is switched
+// to CLOCK_MONOTONIC at START), so they compare directly against bpftrace's nsecs.
+
+#ifndef DEBOUNCED_NO_SDT
+#if defined(__has_include) && !__has_include(<sys/sdt.h>)
+#error "<sys/sdt.h> not found: install the systemtap SDT headers or build with SDT=0"
+#else
+#include <sys/sdt.h>
+#endif
+#define PROBE2(name, a, b) DTRACE_PROBE2(debounced, name, a, b)
+#define PROBE3(name, a, b, c) DTRACE_PROBE3(debounced, name, a, b, c)
+#define PROBE4(name, a, b, c, d) DTRACE_PROBE4(debounced, name, a, b, c, d)
+#else
+#define PROBE2(name, a, b) do { (void)(a); (void)(b); } while (0)
+#define PROBE3(name, a, b, c) do { (void)(a); (void)(b); (void)(c); } while (0)
+#define PROBE4(name, a, b, c, d) do { (void)(a); (void)(b); (void)(c); (void)(d); } while (0)
+#endif
+
+// process_debounce() outcomes, passed as the decision argument of the debounce probe
+#define DB_PASS 0
+#define DB_CANCEL_UP 1
+#define DB_UP_PENDING 2
+#define DB_REPEAT 3
+#define DB_IGNORED 4
+
+// Why a pending release timer was dropped, passed as the reason argument of timer_cancel
+#define TC_REPRESS 0
+#define TC_REARM 1
+#define TC_RESET 2
+
+#define TV_US(tv) ((tv) ? (unsigned long long)(tv)->tv_sec * 1000000ULL + (tv)->tv_usec : 0ULL)
+
+#endif
@@ -0,0 +1,113 @@
+// User-space instructions per key event for each specialized batch handler and for a
+// generic handler that tests the mode switches at run time, as before specialization.
+// Instructions are counted by single-stepping a traced child between two SIGSTOP
+// markers, so no PMU is needed; syscalls count as one instruction each.
+// Build and run with: make SDT=0 bench
+#include <sys/ptrace.h>
+#include <sys/wait.h>
+
+#define main debounced_main
+#include "../src/debounced.c"
+#undef main
+
+#define BENCH_KEYS 16
+
+// Mode switches for the generic handler; volatile so they stay run-time tests
+static volatile int g_db, g_ft, g_rm, g_log;
+
+__attribute__((noinline)) static void handle_batch_generic(const struct input_event *evs, int n) {
+    handle_batch(evs, n, g_db, g_ft, g_rm, g_log);
+}
+
+__attribute__((noinline)) static void handle_batch_empty(const struct input_event *evs, int n) {
+    (void)evs;
+    (void)n;
+    __asm__ volatile("" ::: "memory");
+}
+
+// Typing over a mix of plain keys and both FlashTap pairs: press, SYN, release, SYN
+static int build_batch(struct input_event *evs) {
+    static const int codes[BENCH_KEYS] = {KEY_Q, KEY_A, KEY_W, KEY_D, KEY_E,    KEY_S, KEY_LEFT, KEY_R,
+                                          KEY_T, KEY_RIGHT, KEY_Y, KEY_U, KEY_I, KEY_O, KEY_P,    KEY_SPACE};
+    int n = 0;
+    for (int i = 0; i < BENCH_KEYS; i++) {
+        for (int v = 1; v >= 0; v--) {
+            evs[n++] = (struct input_event){.type = EV_KEY, .code = codes[i], .value = v};
+            evs[n++] = (struct input_event){.type = EV_SYN, .code = SYN_REPORT, .value = 0};
+        }
+    }
+    return n;
+}
+
+// One warm-up call to settle lazy binding and caches, then one traced call
+static void run(batch_handler_t fn, const struct input_event *evs, int n) {
+    fn(evs, n);
+    raise(SIGSTOP);
+    fn(evs, n);
+    raise(SIGSTOP);
+}
+
+static void child(void) {
+    struct input_event evs[READ_BATCH];
+    int n = build_batch(evs);
+    if (!freopen("/dev/null", "w", stdout) || !freopen("/dev/null", "w", stderr)) _exit(1);
+    fd_out = open("/dev/null", O_WRONLY);
+    for (int i = 0; i < KEY_MAX; i++) keys[i].timerfd = keys[i].remap_out = -1;
+    debounce_ms = 0;  // every release passes immediately, no timers
+    ft_ad_enabled = ft_arrows_enabled = 1;
+    remap_base[KEY_CAPSLOCK] = (RemapAction){ACT_KEY, KEY_ESC, 0};
+
+    ptrace(PTRACE_TRACEME, 0, NULL, NULL);
+    run(handle_batch_empty, evs, n);
+    for (int v = 0; v < 16; v++) {
+        g_db = v >> 3 & 1;
+        g_ft = v >> 2 & 1;
+        g_rm = v >> 1 & 1;
+        g_log = v & 1;
+        remap_enabled = g_rm;
+        run(handle_batch_generic, evs, n);
+        run(batch_handlers[g_db][g_ft][g_rm][g_log], evs, n);
+    }
+    _exit(0);
+}
+
+int main(void) {
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return 1;
+    }
+    if (pid == 0) child();
+
+    // Every SIGSTOP toggles counting; results arrive in the order child() runs them
+    unsigned long counts[1 + 16 * 2], steps = 0;
+    int nresults = 0, counting = 0, status;
+    while (waitpid(pid, &status, 0) == pid && WIFSTOPPED(status)) {
+        int sig = WSTOPSIG(status);
+        if (sig == SIGSTOP) {
+            if (counting && nresults < (int)(sizeof(counts) / sizeof(counts[0]))) counts[nresults++] = steps;
+            counting = !counting;
+            steps = 0;
+            sig = 0;
+        } else if (sig == SIGTRAP) {
+            steps++;
+            sig = 0;
+        }
+        ptrace(counting ? PTRACE_SINGLESTEP : PTRACE_CONT, pid, NULL, (void *)(long)sig);
+    }
+    if (nresults != 1 + 16 * 2) {
+        fprintf(stderr, "bench: child stopped after %d of %d runs\n", nresults, 1 + 16 * 2);
+        return 1;
+    }
+
+    unsigned long base = counts[0];
+    printf("instructions per key event (%d keys, press+release), generic vs specialized\n", BENCH_KEYS);
+    printf("db ft rm log  generic  special  saved\n");
+    for (int v = 0; v < 16; v++) {
+        double gen = (double)(counts[1 + 2 * v] - base) / (2 * BENCH_KEYS);
+        double spec = (double)(counts[2 + 2 * v] - base) / (2 * BENCH_KEYS);
+        printf(" %d  %d  %d   %d  %7.1f  %7.1f  %4.1f%%\n", v >> 3 & 1, v >> 2 & 1, v >> 1 & 1, v & 1, gen, spec,
+               100.0 * (gen - spec) / gen);
+    }
+    return 0;
+}
@@ -0,0 +1,174 @@
+// End-to-end check of the HID-BPF backend on a virtual uhid boot keyboard.
+// Needs root, /dev/uhid and a kernel with struct_ops HID-BPF (6.11+).
+// Build and run with: sudo make BPF=1 check-bpf
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <linux/uhid.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "hid_bpf.h"
+
+#define DEV_NAME "debounced-uhid-test"
+#define DEBOUNCE_MS 50
+
+// HID usages in the boot report
+#define U_A 0x04
+#define U_D 0x07
+
+// Boot keyboard without report IDs, the only layout the BPF program accepts
+static const uint8_t rdesc[] = {
+    0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7, 0x15, 0x00, 0x25, 0x01,
+    0x75, 0x01, 0x95, 0x08, 0x81, 0x02, 0x95, 0x01, 0x75, 0x08, 0x81, 0x01, 0x95, 0x05, 0x75, 0x01,
+    0x05, 0x08, 0x19, 0x01, 0x29, 0x05, 0x91, 0x02, 0x95, 0x01, 0x75, 0x03, 0x91, 0x01, 0x95, 0x06,
+    0x75, 0x08, 0x15, 0x00, 0x25, 0x65, 0x05, 0x07, 0x19, 0x00, 0x29, 0x65, 0x81, 0x00, 0xC0,
+};
+
+static int uhid_fd = -1, ev_fd = -1;
+static int key_a, key_d;      // state as reported through evdev
+static int a_downs, a_ups;    // KEY_A transitions seen
+static int failures;
+
+static void sleep_ms(unsigned ms) {
+    struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+static int uhid_write(const struct uhid_event *ev) {
+    if (write(uhid_fd, ev, sizeof(*ev)) != sizeof(*ev)) {
+        perror("uhid write");
+        return -1;
+    }
+    return 0;
+}
+
+// Sends a boot report holding the given key usages (0 terminates)
+static void send_keys(uint8_t k1, uint8_t k2) {
+    struct uhid_event ev = {.type = UHID_INPUT2};
+    ev.u.input2.size = 8;
+    ev.u.input2.data[2] = k1;
+    ev.u.input2.data[3] = k2;
+    uhid_write(&ev);
+}
+
+static int create_device(void) {
+    struct uhid_event ev = {.type = UHID_CREATE2};
+    snprintf((char *)ev.u.create2.name, sizeof(ev.u.create2.name), DEV_NAME);
+    memcpy(ev.u.create2.rd_data, rdesc, sizeof(rdesc));
+    ev.u.create2.rd_size = sizeof(rdesc);
+    ev.u.create2.bus = BUS_USB;
+    ev.u.create2.vendor = 0x1209;
+    ev.u.create2.product = 0x0001;
+    return uhid_write(&ev);
+}
+
+// Finds the evdev node hid-input created for the uhid device
+static int open_evdev(void) {
+    char path[300], name[256];
+    for (int tries = 0; tries < 200; tries++) {
+        DIR *d = opendir("/sys/class/input");
+        struct dirent *de;
+        while (d && (de = readdir(d))) {
+            if (strncmp(de->d_name, "event", 5) != 0) continue;
+            snprintf(path, sizeof(path), "/sys/class/input/%s/device/name", de->d_name);
+            FILE *f = fopen(path, "r");
+            if (!f) continue;
+            int match = fgets(name, sizeof(name), f) && strncmp(name, DEV_NAME, strlen(DEV_NAME)) == 0;
+            fclose(f);
+            if (!match) continue;
+            snprintf(path, sizeof(path), "/dev/input/%s", de->d_name);
+            closedir(d);
+            ev_fd = open(path, O_RDONLY | O_NONBLOCK);
+            if (ev_fd < 0) {
+                perror(path);
+                return -1;
+            }
+            return hidbpf_attach(path, DEBOUNCE_MS, 1, 0);
+        }
+        if (d) closedir(d);
+        sleep_ms(10);
+    }
+    fprintf(stderr, "no evdev node for %s\n", DEV_NAME);
+    return -1;
+}
+
+// Reads evdev events for up to ms milliseconds, tracking A/D state
+static void drain(unsigned ms) {
+    struct pollfd p = {ev_fd, POLLIN, 0};
+    struct input_event evs[64];
+    while (poll(&p, 1, ms) > 0) {
+        ssize_t r = read(ev_fd, evs, sizeof(evs));
+        if (r <= 0) break;
+        for (size_t i = 0; i < r / sizeof(evs[0]); i++) {
+            if (evs[i].type != EV_KEY || evs[i].value == 2) continue;
+            if (evs[i].code == KEY_A) {
+                key_a = evs[i].value;
+                if (evs[i].value) a_downs++; else a_ups++;
+            } else if (evs[i].code == KEY_D) {
+                key_d = evs[i].value;
+            }
+        }
+    }
+}
+
+static void check(int ok, const char *what) {
+    printf("%s: %s\n", ok ? "PASS" : "FAIL", what);
+    if (!ok) failures++;
+}
+
+static void test_bounce(void) {
+    a_downs = a_ups = 0;
+    send_keys(U_A, 0);
+    sleep_ms(5);
+    send_keys(0, 0);  // release 5ms after press: held back
+    sleep_ms(5);
+    send_keys(U_A, 0);  // bounce: cancels the pending release
+    sleep_ms(5);
+    send_keys(0, 0);
+    drain(DEBOUNCE_MS / 2);
+    check(key_a == 1 && a_ups == 0, "early release held back");
+    drain(DEBOUNCE_MS * 2);
+    check(a_downs == 1 && a_ups == 1 && key_a == 0, "bounce collapsed into one press");
+}
+
+static void test_flashtap(void) {
+    send_keys(U_A, 0);
+    drain(DEBOUNCE_MS * 2);
+    check(key_a == 1 && key_d == 0, "A down");
+    send_keys(U_A, U_D);
+    drain(DEBOUNCE_MS * 2);
+    check(key_a == 0 && key_d == 1, "D overrides A while both held");
+    send_keys(U_A, 0);
+    drain(DEBOUNCE_MS * 2);
+    check(key_a == 1 && key_d == 0, "A restored after D released");
+    send_keys(0, 0);
+    drain(DEBOUNCE_MS * 2);
+    check(key_a == 0 && key_d == 0, "all released");
+}
+
+int main(void) {
+    uhid_fd = open("/dev/uhid", O_RDWR | O_CLOEXEC);
+    if (uhid_fd < 0) {
+        perror("/dev/uhid");
+        return 77;
+    }
+    if (create_device() < 0 || open_evdev() < 0) return 1;
+    drain(100);
+    test_bounce();
+    test_flashtap();
+    hidbpf_detach();
+    struct uhid_event ev = {.type = UHID_DESTROY};
+    uhid_write(&ev);
+    close(ev_fd);
+    close(uhid_fd);
+    printf("%d failure(s)\n", failures);
+    return failures ? 1 : 0;
+}